@@ -3,9 +3,11 @@
 
 layout(location = 0) in vec4 position;
 
+uniform mat3 view;
+
 void main()
 {
-   gl_Position = position;
+   gl_Position = vec4((view * vec3(position.xy, 1.0)).xy, 0.0, 1.0);
 };
 
 #shader fragment
@@ -12,6 +12,9 @@
 #include <complex>
 #include <chrono>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <map>
 
 using namespace std::chrono;
 using namespace std;
@@ -173,6 +176,39 @@ float dot(vec2 p1, vec2 p2)
     return p1.x * p2.x + p1.y * p2.y;
 }
 
+float pointSegmentDistance(vec2 p, vec2 a, vec2 b)
+{
+    vec2 ab = b - a;
+    float lengthSquared = dot(ab, ab);
+    float t = lengthSquared > 0 ? dot(p - a, ab) / lengthSquared : 0;
+    t = max(0.0f, min(1.0f, t));
+    return (p - (a + ab * t)).norm();
+}
+
+float segmentsDistance(vec2 a, vec2 b, vec2 c, vec2 d)
+{
+    float d1 = crossProduct(b - a, c - a);
+    float d2 = crossProduct(b - a, d - a);
+    float d3 = crossProduct(d - c, a - c);
+    float d4 = crossProduct(d - c, b - c);
+    if (((d1 < 0 && d2 > 0) || (d1 > 0 && d2 < 0)) && ((d3 < 0 && d4 > 0) || (d3 > 0 && d4 < 0)))
+        return 0;
+
+    return min(min(pointSegmentDistance(a, c, d), pointSegmentDistance(b, c, d)),
+        min(pointSegmentDistance(c, a, b), pointSegmentDistance(d, a, b)));
+}
+
+// True if the segment swept by a disk of the given radius touches the closed outline's edges
+bool segmentHitsOutline(const vec2* points, int size, vec2 from, vec2 to, float radius)
+{
+    for (int i = 0, j = size - 1; i < size; j = i++)
+    {
+        if (segmentsDistance(from, to, points[j], points[i]) < radius)
+            return true;
+    }
+    return false;
+}
+
 void CreateCircleVertices(vec2 center, float radius, vec2 *vertices)
 {
     vertices[0] = center;
@@ -214,7 +250,13 @@ class obstacle
 public:
     int verticesNeeded = 0;
     int indicesNeeded = 0;
+    bool valid = true;
+    vec2 boundsMin = vec2(-1e30f, -1e30f);
+    vec2 boundsMax = vec2(1e30f, 1e30f);
     virtual  bool insideObstacle(vec2 point) { return false; }
+    // Exact test for a disk of the given radius moving from one point to another, used to
+    // validate whole steps where insideObstacle only sees the sampled positions
+    virtual bool segmentHits(vec2 from, vec2 to, float radius) { return false; }
     virtual void createVertices(vec2* arr) {}
     virtual void createIndices(unsigned int* arr, int indexOffset) {}
 };
@@ -231,6 +273,8 @@ public:
         verticesNeeded = 3;
         indicesNeeded = 3;
         vertices = new vec2[3]{ p1, p2, p3 };
+        boundsMin = vec2(min(p1.x, min(p2.x, p3.x)), min(p1.y, min(p2.y, p3.y)));
+        boundsMax = vec2(max(p1.x, max(p2.x, p3.x)), max(p1.y, max(p2.y, p3.y)));
         edges = new vec2[3]{
             vertices[1] - vertices[0],
             vertices[2] - vertices[1],
@@ -247,6 +291,11 @@ public:
         return ((ABxAP < 0 && BCxBP < 0 && CAxCP < 0) || (ABxAP > 0 && BCxBP > 0 && CAxCP > 0));
     }
 
+    bool segmentHits(vec2 from, vec2 to, float radius)
+    {
+        return insideObstacle(from) || segmentHitsOutline(vertices, 3, from, to, max(radius, 1e-6f));
+    }
+
     void createVertices(vec2* arr) override
     {
         for (int i = 0; i < 3; i++)
@@ -275,6 +324,8 @@ public:
         indicesNeeded = PointsPerCircle * 3;
         center = c;
         radius = r;
+        boundsMin = c - vec2(r, r);
+        boundsMax = c + vec2(r, r);
     }
 
     bool insideObstacle(vec2 point)
@@ -282,6 +333,11 @@ public:
         return (point - center).norm() < radius;
     }
 
+    bool segmentHits(vec2 from, vec2 to, float r)
+    {
+        return pointSegmentDistance(center, from, to) < radius + r;
+    }
+
     void createVertices(vec2* arr)
     {
         CreateCircleVertices(center, radius, arr);
@@ -296,14 +352,269 @@ public:
     }
 };
 
+// Simple (possibly concave) polygon. The triangulation is computed once by ear
+// clipping and the edges are bucketed into horizontal slabs, so insideObstacle
+// is a bounding box test plus two binary searches instead of a walk over every edge.
+class polygon : public obstacle
+{
+public:
+    struct edge
+    {
+        vec2 start;
+        float dxdy;
+
+        float xAt(float y) const
+        {
+            return start.x + (y - start.y) * dxdy;
+        }
+    };
+
+    vector<vec2> vertices;
+    vector<unsigned int> triangulation;
+    vector<edge> edges;
+    vector<float> slabBounds;
+    vector<vector<int>> slabEdges;
+
+    polygon(const vector<vec2> &points)
+    {
+        // Outlines often repeat a vertex or close the ring on their first point
+        for (auto& p : points)
+        {
+            if (vertices.empty() || p.x != vertices.back().x || p.y != vertices.back().y)
+                vertices.push_back(p);
+        }
+        while (vertices.size() > 1 && vertices.back().x == vertices[0].x && vertices.back().y == vertices[0].y)
+            vertices.pop_back();
+
+        if (vertices.size() < 3)
+        {
+            cout << "Polygon needs at least 3 distinct vertices, got " << vertices.size() << endl;
+            reject();
+            return;
+        }
+
+        // The slabs only count crossings right for edges that never cross each other
+        if (selfIntersecting())
+        {
+            cout << "Polygon outline with " << vertices.size() << " vertices crosses itself" << endl;
+            reject();
+            return;
+        }
+
+        if (signedArea() < 0)
+            reverse(vertices.begin(), vertices.end());
+
+        if (!earClip())
+        {
+            cout << "Failed to triangulate polygon with " << vertices.size() << " vertices" << endl;
+            reject();
+            return;
+        }
+        verticesNeeded = vertices.size();
+        indicesNeeded = triangulation.size();
+
+        boundsMin = boundsMax = vertices[0];
+        for (auto& v : vertices)
+        {
+            boundsMin = vec2(min(boundsMin.x, v.x), min(boundsMin.y, v.y));
+            boundsMax = vec2(max(boundsMax.x, v.x), max(boundsMax.y, v.y));
+        }
+        buildSlabs();
+    }
+
+    // Leaves an empty obstacle that is neither drawn nor sensed
+    void reject()
+    {
+        valid = false;
+        vertices.clear();
+        triangulation.clear();
+        verticesNeeded = 0;
+        indicesNeeded = 0;
+        boundsMin = boundsMax = vec2(0, 0);
+    }
+
+    bool selfIntersecting()
+    {
+        int n = vertices.size();
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = i + 2; j < n; j++)
+            {
+                if (i == 0 && j == n - 1)
+                    continue;
+                if (segmentsDistance(vertices[i], vertices[(i + 1) % n], vertices[j], vertices[(j + 1) % n]) == 0)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    float signedArea()
+    {
+        float area = 0;
+        for (int i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++)
+            area += crossProduct(vertices[j], vertices[i]);
+        return area / 2;
+    }
+
+    bool earClip()
+    {
+        vector<int> remaining(vertices.size());
+        for (int i = 0; i < remaining.size(); i++)
+            remaining[i] = i;
+
+        int fails = 0;
+        int i = 0;
+        while (remaining.size() > 3 && fails < remaining.size())
+        {
+            int n = remaining.size();
+            int prev = remaining[(i + n - 1) % n];
+            int curr = remaining[i % n];
+            int next = remaining[(i + 1) % n];
+            if (isEar(remaining, prev, curr, next))
+            {
+                triangulation.insert(triangulation.end(), { (unsigned int)prev, (unsigned int)curr, (unsigned int)next });
+                remaining.erase(remaining.begin() + i % n);
+                fails = 0;
+            }
+            else
+            {
+                i++;
+                fails++;
+            }
+            i %= remaining.size();
+        }
+        if (remaining.size() != 3)
+            return false;
+
+        triangulation.insert(triangulation.end(), { (unsigned int)remaining[0], (unsigned int)remaining[1], (unsigned int)remaining[2] });
+        return true;
+    }
+
+    bool isEar(const vector<int> &remaining, int prev, int curr, int next)
+    {
+        vec2 a = vertices[prev];
+        vec2 b = vertices[curr];
+        vec2 c = vertices[next];
+        if (crossProduct(b - a, c - b) <= 0)
+            return false;
+
+        for (int k : remaining)
+        {
+            if (k == prev || k == curr || k == next)
+                continue;
+            vec2 p = vertices[k];
+            if (crossProduct(b - a, p - a) >= 0 && crossProduct(c - b, p - b) >= 0 && crossProduct(a - c, p - c) >= 0)
+                return false;
+        }
+        return true;
+    }
+
+    void buildSlabs()
+    {
+        for (auto& v : vertices)
+            slabBounds.push_back(v.y);
+        sort(slabBounds.begin(), slabBounds.end());
+        slabBounds.erase(unique(slabBounds.begin(), slabBounds.end()), slabBounds.end());
+        slabEdges.resize(slabBounds.size() - 1);
+
+        for (int i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++)
+        {
+            vec2 a = vertices[j];
+            vec2 b = vertices[i];
+            if (a.y == b.y)
+                continue;
+            if (a.y > b.y)
+                swap(a, b);
+
+            int edgeIndex = edges.size();
+            edges.push_back({ a, (b.x - a.x) / (b.y - a.y) });
+            int first = lower_bound(slabBounds.begin(), slabBounds.end(), a.y) - slabBounds.begin();
+            int last = lower_bound(slabBounds.begin(), slabBounds.end(), b.y) - slabBounds.begin();
+            for (int slab = first; slab < last; slab++)
+                slabEdges[slab].push_back(edgeIndex);
+        }
+
+        // Edges of a simple polygon never cross inside a slab, so their left to right
+        // order at the slab's middle holds for every y in it.
+        for (int slab = 0; slab < slabEdges.size(); slab++)
+        {
+            float midY = (slabBounds[slab] + slabBounds[slab + 1]) / 2;
+            sort(slabEdges[slab].begin(), slabEdges[slab].end(), [&](int e1, int e2) {
+                return edges[e1].xAt(midY) < edges[e2].xAt(midY);
+            });
+        }
+    }
+
+    bool insideObstacle(vec2 point)
+    {
+        // Written so NaN coordinates fail the test too, they would index outside the slabs
+        if (!(point.x > boundsMin.x && point.x < boundsMax.x && point.y > boundsMin.y && point.y < boundsMax.y))
+            return false;
+
+        int slab = upper_bound(slabBounds.begin(), slabBounds.end(), point.y) - slabBounds.begin() - 1;
+        if (slab < 0 || slab >= slabEdges.size())
+            return false;
+        const vector<int>& slabList = slabEdges[slab];
+        int crossings = partition_point(slabList.begin(), slabList.end(), [&](int e) {
+            return edges[e].xAt(point.y) < point.x;
+        }) - slabList.begin();
+
+        return crossings % 2 == 1;
+    }
+
+    bool segmentHits(vec2 from, vec2 to, float radius)
+    {
+        if (max(from.x, to.x) + radius < boundsMin.x || min(from.x, to.x) - radius > boundsMax.x ||
+            max(from.y, to.y) + radius < boundsMin.y || min(from.y, to.y) - radius > boundsMax.y)
+            return false;
+
+        return insideObstacle(from) || segmentHitsOutline(vertices.data(), vertices.size(), from, to, max(radius, 1e-6f));
+    }
+
+    void createVertices(vec2* arr)
+    {
+        for (int i = 0; i < vertices.size(); i++)
+        {
+            arr[i] = vertices[i];
+        }
+    }
+
+    void createIndices(unsigned int* arr, int indexOffset)
+    {
+        for (int i = 0; i < triangulation.size(); i++)
+        {
+            arr[i] = triangulation[i] + indexOffset;
+        }
+    }
+};
+
+struct chunk
+{
+    unsigned int indexOffset;
+    unsigned int indexCount;
+    vec2 boundsMin;
+    vec2 boundsMax;
+};
+
 struct obstacleWorld
 {
     vec2* vertices;
     unsigned int* indices;
     unsigned int verticesSize;
     unsigned int indicesSize;
-
-    obstacleWorld(vector<obstacle*> obstacleList)
+    vector<chunk> chunks;
+    vector<vector<int>> cellChunks;
+    vector<unsigned int> chunkVisits;
+    unsigned int visitStamp = 0;
+    vec2 boundsMin = vec2(0, 0);
+    vec2 boundsMax = vec2(0, 0);
+    vec2 gridMin;
+    int gridWidth = 0;
+    int gridHeight = 0;
+    float chunkSize = 1;
+
+    obstacleWorld(vector<obstacle*> obstacleList, int trianglesPerChunk = 256)
     {
         verticesSize = 0;
         indicesSize = 0;
@@ -325,6 +636,155 @@ struct obstacleWorld
             curriVertex += currObstacle -> verticesNeeded;
             curriIndex += currObstacle -> indicesNeeded;
         }
+
+        createChunks(trianglesPerChunk);
+    }
+
+    // Lays a grid over the world's bounds sized so a cell holds about trianglesPerChunk
+    // triangles, groups the triangles by the cell holding their centroid and reorders
+    // the index buffer so every cell is one contiguous range that can be culled on its own.
+    // Each chunk is then listed in every cell its bounds overlap, so long triangles are
+    // found from any cell they reach into.
+    void createChunks(int trianglesPerChunk)
+    {
+        int triangleCount = indicesSize / 3;
+        if (triangleCount == 0)
+            return;
+
+        boundsMin = boundsMax = vertices[indices[0]];
+        for (int i = 0; i < indicesSize; i++)
+        {
+            vec2 v = vertices[indices[i]];
+            boundsMin = vec2(min(boundsMin.x, v.x), min(boundsMin.y, v.y));
+            boundsMax = vec2(max(boundsMax.x, v.x), max(boundsMax.y, v.y));
+        }
+        vec2 worldSize = boundsMax - boundsMin;
+        float cellsWanted = max(1.0f, (float)triangleCount / trianglesPerChunk);
+        // The second term keeps long thin worlds from getting more cells than chunks
+        chunkSize = max(sqrt(worldSize.x * worldSize.y / cellsWanted), max(worldSize.x, worldSize.y) / cellsWanted);
+        if (!(chunkSize > 0))
+            chunkSize = 1;
+
+        gridMin = boundsMin;
+        gridWidth = (int)(worldSize.x / chunkSize) + 1;
+        gridHeight = (int)(worldSize.y / chunkSize) + 1;
+
+        vector<vector<unsigned int>> cells(gridWidth * gridHeight);
+        for (int i = 0; i < indicesSize; i += 3)
+        {
+            vec2 centroid = (vertices[indices[i]] + vertices[indices[i + 1]] + vertices[indices[i + 2]]) / 3;
+            int cellX = min((int)((centroid.x - gridMin.x) / chunkSize), gridWidth - 1);
+            int cellY = min((int)((centroid.y - gridMin.y) / chunkSize), gridHeight - 1);
+            vector<unsigned int> &cell = cells[cellY * gridWidth + cellX];
+            cell.insert(cell.end(), &indices[i], &indices[i + 3]);
+        }
+
+        cellChunks.assign(gridWidth * gridHeight, vector<int>());
+        unsigned int curriIndex = 0;
+        for (int c = 0; c < cells.size(); c++)
+        {
+            if (cells[c].empty())
+                continue;
+
+            chunk currChunk;
+            currChunk.indexOffset = curriIndex;
+            currChunk.indexCount = cells[c].size();
+            currChunk.boundsMin = currChunk.boundsMax = vertices[cells[c][0]];
+            for (auto index : cells[c])
+            {
+                vec2 v = vertices[index];
+                currChunk.boundsMin = vec2(min(currChunk.boundsMin.x, v.x), min(currChunk.boundsMin.y, v.y));
+                currChunk.boundsMax = vec2(max(currChunk.boundsMax.x, v.x), max(currChunk.boundsMax.y, v.y));
+                indices[curriIndex++] = index;
+            }
+
+            int firstX, firstY, lastX, lastY;
+            cellRange(currChunk.boundsMin, currChunk.boundsMax, firstX, firstY, lastX, lastY);
+            for (int cellY = firstY; cellY <= lastY; cellY++)
+            {
+                for (int cellX = firstX; cellX <= lastX; cellX++)
+                    cellChunks[cellY * gridWidth + cellX].push_back(chunks.size());
+            }
+            chunks.push_back(currChunk);
+        }
+        chunkVisits.assign(chunks.size(), 0);
+    }
+
+    // Grid cells covering a rectangle, clamped to the grid. Empty when lastX < firstX or lastY < firstY
+    void cellRange(vec2 rectMin, vec2 rectMax, int &firstX, int &firstY, int &lastX, int &lastY)
+    {
+        vec2 first = (rectMin - gridMin) / chunkSize;
+        vec2 last = (rectMax - gridMin) / chunkSize;
+        firstX = max((int)floor(first.x), 0);
+        firstY = max((int)floor(first.y), 0);
+        lastX = min((int)floor(last.x), gridWidth - 1);
+        lastY = min((int)floor(last.y), gridHeight - 1);
+    }
+
+    // Only walks the grid cells under the view rectangle, so the cost follows what is on screen
+    void visibleChunks(vec2 viewMin, vec2 viewMax, vector<GLsizei> &counts, vector<const void*> &offsets)
+    {
+        counts.clear();
+        offsets.clear();
+        if (chunks.empty())
+            return;
+
+        // A chunk listed in several visible cells is only drawn once per call
+        visitStamp++;
+        int firstX, firstY, lastX, lastY;
+        cellRange(viewMin, viewMax, firstX, firstY, lastX, lastY);
+        for (int cellY = firstY; cellY <= lastY; cellY++)
+        {
+            for (int cellX = firstX; cellX <= lastX; cellX++)
+            {
+                for (int chunkIndex : cellChunks[cellY * gridWidth + cellX])
+                {
+                    if (chunkVisits[chunkIndex] == visitStamp)
+                        continue;
+                    chunkVisits[chunkIndex] = visitStamp;
+
+                    chunk &currChunk = chunks[chunkIndex];
+                    if (currChunk.boundsMax.x < viewMin.x || currChunk.boundsMin.x > viewMax.x ||
+                        currChunk.boundsMax.y < viewMin.y || currChunk.boundsMin.y > viewMax.y)
+                        continue;
+                    counts.push_back(currChunk.indexCount);
+                    offsets.push_back((const void*)(currChunk.indexOffset * sizeof(unsigned int)));
+                }
+            }
+        }
+    }
+};
+
+struct camera
+{
+    vec2 center = vec2(0, 0);
+    float zoom = 1;
+    bool followRobot = false;
+
+    // Column major world to NDC transform for the shader's view uniform
+    void viewMatrix(float* m)
+    {
+        m[0] = zoom; m[1] = 0;    m[2] = 0;
+        m[3] = 0;    m[4] = zoom; m[5] = 0;
+        m[6] = -center.x * zoom;  m[7] = -center.y * zoom; m[8] = 1;
+    }
+
+    vec2 viewMin()
+    {
+        return center - vec2(1, 1) / zoom;
+    }
+
+    vec2 viewMax()
+    {
+        return center + vec2(1, 1) / zoom;
+    }
+
+    // Centers on a rectangle and zooms so all of it fits with a small margin
+    void frame(vec2 rectMin, vec2 rectMax)
+    {
+        center = (rectMin + rectMax) / 2.0f;
+        float extent = max(rectMax.x - rectMin.x, rectMax.y - rectMin.y) * 1.1f;
+        zoom = extent > 0 ? 2 / extent : 1;
     }
 };
 
@@ -339,15 +799,49 @@ float angleStep = .01;
 vec2 movingTowards = robotCenter;
 bool followingBorder = false;
 float raySpeed = robotSpeed / 4;
+float followClearance = 2 * robotRadius;
+vec2 goalDirection;
+float distToGoal;
+float dreach;
+float dfollowed;
+vec2 lastDirection;
+vec2 pointToFollow;
+float lastHeuristic;
+float pathLength;
+duration<double> senseTime;
+camera sceneCamera;
+float cameraPanSpeed = 0.02;
+float cameraZoomStep = 1.1;
+const float identityView[] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
 
 bool raycast(vec2 origin, vec2 direction, float r, vector<obstacle*> &obstacleList, vec2 &hitPoint)
 {
     hitPoint = origin;
     vec2 step = direction * raySpeed;
+
+    // Only obstacles whose bounds overlap the ray's segment can be hit
+    vec2 end = origin + direction * r;
+    vec2 rayMin(min(origin.x, end.x), min(origin.y, end.y));
+    vec2 rayMax(max(origin.x, end.x), max(origin.y, end.y));
+    // Reused between rays, circleCast casts hundreds of them every step
+    static vector<obstacle*> candidates;
+    candidates.clear();
+    for (auto obs : obstacleList)
+    {
+        if (obs -> boundsMax.x >= rayMin.x && obs -> boundsMin.x <= rayMax.x &&
+            obs -> boundsMax.y >= rayMin.y && obs -> boundsMin.y <= rayMax.y)
+            candidates.push_back(obs);
+    }
+    if (candidates.empty())
+    {
+        hitPoint = origin + step * ceil(r / raySpeed);
+        return false;
+    }
+
     for (int i = 0; i < r / raySpeed; i++)
     {
         hitPoint += step;
-        for (auto obs : obstacleList)
+        for (auto obs : candidates)
         {
             if (obs -> insideObstacle(hitPoint))
                 return true;
@@ -356,26 +850,475 @@ bool raycast(vec2 origin, vec2 direction, float r, vector<obstacle*> &obstacleLi
     return false;
 }
 
+// Casts rays all around the origin and returns a point in free space next to every
+// edge where the rays go from missing to hitting an obstacle. The point is turned away
+// from the obstacle until it clears every hit point of the adjacent blocked arc within
+// a quarter turn by followClearance, keeping the robot's disk off the boundary.
 void circleCast(vec2 origin, float r, vector<obstacle*> &obstacleList, vector<vec2> &hitPoints)
 {
+    static vector<bool> hits;
+    static vector<float> hitDistances;
+    int rays = ceil(M_PI2 / angleStep);
+    hits.resize(rays);
+    hitDistances.resize(rays);
+
     vec2 hitPoint;
-    vec2 lastHitPoint;
-    bool hittingObstacle = raycast(origin, vec2(1, 0), r, obstacleList, hitPoint);
-    for (float angle = angleStep; angle < M_PI2; angle += angleStep)
+    for (int k = 0; k < rays; k++)
+    {
+        float angle = k * angleStep;
+        hits[k] = raycast(origin, vec2(cos(angle), sin(angle)), r, obstacleList, hitPoint);
+        hitDistances[k] = (hitPoint - origin).norm();
+    }
+
+    for (int k = 0; k < rays; k++)
+    {
+        int prev = (k + rays - 1) % rays;
+        if (hits[k] == hits[prev])
+            continue;
+
+        int hitRay = hits[k] ? k : prev;
+        int missRay = hits[k] ? prev : k;
+        int side = hits[k] ? -1 : 1;
+        float turn = angleStep;
+        for (int j = 0; j * angleStep < M_PI / 2 && j < rays; j++)
+        {
+            int ray = ((hitRay - side * j) % rays + rays) % rays;
+            if (!hits[ray])
+                break;
+            float clearanceAngle = asin(min(1.0f, followClearance / max(hitDistances[ray], 1e-6f)));
+            turn = max(turn, clearanceAngle - j * angleStep);
+        }
+        float angle = hitRay * angleStep + side * turn;
+        vec2 direction(cos(angle), sin(angle));
+        if (raycast(origin, direction, r, obstacleList, hitPoint))
+            direction = vec2(cos(missRay * angleStep), sin(missRay * angleStep));
+        hitPoints.push_back(origin + direction * r);
+    }
+}
+
+void scrollCallback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    sceneCamera.zoom *= pow(cameraZoomStep, (float)yoffset);
+}
+
+void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if (key == GLFW_KEY_F && action == GLFW_PRESS)
+        sceneCamera.followRobot = !sceneCamera.followRobot;
+}
+
+void updateCamera(GLFWwindow* window)
+{
+    float panStep = cameraPanSpeed / sceneCamera.zoom;
+    vec2 pan(0, 0);
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+        pan.y += panStep;
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+        pan.y -= panStep;
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+        pan.x += panStep;
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+        pan.x -= panStep;
+
+    // Panning by hand takes the camera off the robot
+    if (pan.x != 0 || pan.y != 0)
+        sceneCamera.followRobot = false;
+
+    if (sceneCamera.followRobot)
+        sceneCamera.center = robotCenter;
+    else
+        sceneCamera.center += pan;
+}
+
+void resetRobot(vec2 start, vec2 goal)
+{
+    robotCenter = start;
+    goalCenter = goal;
+    movingTowards = start;
+    followingBorder = false;
+    goalDirection = normalize(goalCenter - robotCenter);
+    distToGoal = (goalCenter - robotCenter).norm();
+    dreach = 999999999;
+    dfollowed = 999999999;
+    pointToFollow = goal;
+    lastDirection = goalDirection;
+    lastHeuristic = 999999999;
+    pathLength = 0;
+    senseTime = duration<double>::zero();
+}
+
+// Checks the way to the goal along the robot's center and both sides of its disk,
+// obstacles behind the goal don't block it. The side rays are shortened to end inside
+// the vision circle so they never see what circleCast can't.
+bool goalPathBlocked(vector<obstacle*> &obstacleList)
+{
+    vec2 raycastHit;
+    vec2 side = vec2(-goalDirection.y, goalDirection.x) * followClearance;
+    float r = min(robotVisionRadius, distToGoal);
+    float sideR = sqrt(max(0.0f, r * r - followClearance * followClearance));
+    return raycast(robotCenter, goalDirection, r, obstacleList, raycastHit) ||
+        raycast(robotCenter + side, goalDirection, sideR, obstacleList, raycastHit) ||
+        raycast(robotCenter - side, goalDirection, sideR, obstacleList, raycastHit);
+}
+
+// Advances the robot one step, returns true once it has reached the goal.
+// Motion to goal heads for the goal or for the obstacle edge with the shortest detour,
+// it switches to following the boundary once that detour stops shrinking. Following
+// keeps turning the same way around the obstacle and leaves once the way to the goal
+// is clear and leads closer to it than the robot has been while following.
+bool stepRobot(vector<obstacle*> &obstacleList)
+{
+    vec2 translation(0, 0);
+    if (distToGoal <= robotSpeed)
+    {
+        pathLength += distToGoal;
+        robotCenter = goalCenter;
+        distToGoal = 0;
+        return true;
+    }
+
+    goalDirection = normalize(goalCenter - robotCenter);
+    auto senseStart = high_resolution_clock::now();
+    bool goalBlocked = goalPathBlocked(obstacleList);
+    senseTime += high_resolution_clock::now() - senseStart;
+
+    // dreach is how close to the goal the free way ahead leads. dfollowed never grows
+    // back, so every time the robot leaves a boundary it has to get strictly closer to
+    // the goal than it ever did while following one
+    dreach = goalBlocked ? 999999999 : distToGoal - min(robotVisionRadius, distToGoal);
+    if (followingBorder && dreach < dfollowed - robotSpeed)
+        followingBorder = false;
+
+    if (!followingBorder && !goalBlocked)
+    {
+        movingTowards = robotCenter + goalDirection * robotVisionRadius;
+        translation = goalDirection * robotSpeed;
+        lastHeuristic = 999999999;
+    }
+    else
+    {
+        vector<vec2> pointsToFollow;
+        senseStart = high_resolution_clock::now();
+        circleCast(robotCenter, robotVisionRadius, obstacleList, pointsToFollow);
+        senseTime += high_resolution_clock::now() - senseStart;
+
+        float bestScore = 9999999999;
+        bool found = false;
+        for (auto& point : pointsToFollow)
+        {
+            float distPointToGoal = (goalCenter - point).norm();
+
+            // Following picks the edge closest to the current heading so it doesn't turn back
+            float score = followingBorder ?
+                -dot(normalize(point - robotCenter), lastDirection) :
+                (point - robotCenter).norm() + distPointToGoal;
+            if (score < bestScore)
+            {
+                bestScore = score;
+                pointToFollow = point;
+                found = true;
+            }
+        }
+
+        if (!followingBorder && found)
+        {
+            if (bestScore > lastHeuristic + robotSpeed / 10)
+            {
+                followingBorder = true;
+                dfollowed = min(dfollowed, distToGoal);
+            }
+            lastHeuristic = bestScore;
+        }
+
+        vec2 raycastHit;
+        if (found)
+        {
+            movingTowards = pointToFollow;
+            translation = normalize(pointToFollow - robotCenter) * robotSpeed;
+            lastDirection = normalize(pointToFollow - robotCenter);
+        }
+        else if (!raycast(robotCenter, goalDirection, min(robotVisionRadius, distToGoal), obstacleList, raycastHit))
+        {
+            // No edge in sight means only a side ray grazed something at the rim of the
+            // vision circle, a step towards the goal is still clear of it
+            followingBorder = false;
+            movingTowards = robotCenter + goalDirection * robotVisionRadius;
+            translation = goalDirection * robotSpeed;
+        }
+    }
+
+    robotCenter += translation;
+    pathLength += translation.norm();
+    distToGoal = (goalCenter - robotCenter).norm();
+    if (followingBorder)
+        dfollowed = min(dfollowed, distToGoal);
+    return false;
+}
+
+struct scenario
+{
+    vec2 start;
+    vec2 goal;
+};
+
+struct worldProfile
+{
+    string name;
+    vector<obstacle*> obstacles;
+    vector<scenario> scenarios;
+};
+
+vector<worldProfile> CreateWorldProfiles()
+{
+    vector<worldProfile> profiles;
+
+    worldProfile circles;
+    circles.name = "circles";
+    circles.obstacles.push_back(new circle(vec2(0, 0.5), .3));
+    circles.obstacles.push_back(new circle(vec2(0, -0.5), .3));
+    circles.scenarios = {
+        { vec2(0, 1), vec2(0, -1) },
+        { vec2(-0.8, 0.9), vec2(0.7, -0.9) },
+        { vec2(0.9, 0.05), vec2(-0.9, -0.05) }
+    };
+    profiles.push_back(circles);
+
+    // Coarse rays tunnel through the thin wall, the cup makes the robot follow a concave boundary
+    worldProfile polygons;
+    polygons.name = "polygons";
+    polygons.obstacles.push_back(new polygon({ vec2(-0.9, 0.396), vec2(0.1, 0.396), vec2(0.1, 0.404), vec2(-0.9, 0.404) }));
+    polygons.obstacles.push_back(new polygon({
+        vec2(-0.4, -0.4), vec2(0.4, -0.4), vec2(0.4, 0.1), vec2(0.3, 0.1),
+        vec2(0.3, -0.3), vec2(-0.3, -0.3), vec2(-0.3, 0.1), vec2(-0.4, 0.1) }));
+    polygons.obstacles.push_back(new polygon({
+        vec2(0.45, -0.65), vec2(0.65, -0.65), vec2(0.65, -0.45), vec2(0.45, -0.45), vec2(0.45, -0.65) }));
+    polygons.scenarios = {
+        { vec2(0, 0.9), vec2(0, -0.9) },
+        { vec2(-0.6, 0.9), vec2(-0.6, -0.1) },
+        { vec2(0.8, -0.9), vec2(-0.5, 0.8) }
+    };
+    profiles.push_back(polygons);
+
+    for (auto& profile : profiles)
+    {
+        auto& obstacles = profile.obstacles;
+        obstacles.erase(remove_if(obstacles.begin(), obstacles.end(), [](obstacle* obs) { return !obs -> valid; }), obstacles.end());
+    }
+
+    return profiles;
+}
+
+struct tuningResult
+{
+    float robotSpeed;
+    float raySpeed;
+    float angleStep;
+    float successRate;
+    float pathDeviation;
+    float senseMicrosPerStep;
+};
+
+// Runs every scenario of the profile with the current parameters, a run fails if the
+// robot's disk touches an obstacle anywhere along a step or has not arrived after
+// maxPathFactor times the straight line distance. The route of each run is the
+// sequence of sides ('+' left, '-' right) of the start to goal line the robot went around.
+void runScenarios(worldProfile &profile, vector<float> &pathLengths, vector<string> &routes, int &steps)
+{
+    const float maxPathFactor = 5;
+    steps = 0;
+    senseTime = duration<double>::zero();
+    duration<double> totalSenseTime = duration<double>::zero();
+    pathLengths.clear();
+    routes.clear();
+    for (auto& currScenario : profile.scenarios)
+    {
+        resetRobot(currScenario.start, currScenario.goal);
+        vec2 line = goalDirection;
+        int maxSteps = maxPathFactor * distToGoal / robotSpeed;
+        bool reached = false;
+        bool collided = false;
+        string route;
+        for (int i = 0; i < maxSteps && !reached && !collided; i++)
+        {
+            vec2 lastCenter = robotCenter;
+            reached = stepRobot(profile.obstacles);
+            steps++;
+            for (auto obs : profile.obstacles)
+                collided = collided || obs -> segmentHits(lastCenter, robotCenter, robotRadius);
+
+            // Offsets within the robot's radius are wobble along the line, not a side
+            vec2 offset = robotCenter - currScenario.start;
+            float side = line.x * offset.y - line.y * offset.x;
+            char sideName = side > robotRadius ? '+' : side < -robotRadius ? '-' : 0;
+            if (sideName && (route.empty() || route.back() != sideName))
+                route += sideName;
+        }
+        totalSenseTime += senseTime;
+        pathLengths.push_back(reached && !collided ? pathLength : -1);
+        routes.push_back(route);
+    }
+    senseTime = totalSenseTime;
+}
+
+// Tries every setting of the grid, finest first. Path deviation is only measured between
+// runs of a scenario that took the same route, against the finest setting that took it,
+// so a coarse setting is not rewarded or punished for going around an obstacle the other
+// way. Sense time is the median of timingRuns repeats of the whole profile.
+vector<tuningResult> TuneProfile(worldProfile &profile)
+{
+    const float robotSpeeds[] = { 0.005, 0.01, 0.02 };
+    const float rayFractions[] = { 0.125, 0.25, 0.5, 1 };
+    const float angleSteps[] = { 0.005, 0.01, 0.02, 0.05 };
+    const int timingRuns = 5;
+
+    vector<tuningResult> results;
+    vector<vector<float>> runLengths;
+    vector<vector<string>> runRoutes;
+    vector<map<string, float>> referenceLengths(profile.scenarios.size());
+    for (float speed : robotSpeeds)
+    {
+        for (float fraction : rayFractions)
+        {
+            for (float step : angleSteps)
+            {
+                robotSpeed = speed;
+                raySpeed = speed * fraction;
+                angleStep = step;
+
+                // Runs are deterministic, only the timing differs between repeats
+                vector<float> pathLengths;
+                vector<string> routes;
+                vector<double> senseMicros;
+                int steps;
+                for (int run = 0; run < timingRuns; run++)
+                {
+                    runScenarios(profile, pathLengths, routes, steps);
+                    senseMicros.push_back(duration_cast<duration<double, micro>>(senseTime).count() / max(steps, 1));
+                }
+                nth_element(senseMicros.begin(), senseMicros.begin() + timingRuns / 2, senseMicros.end());
+
+                int successes = 0;
+                for (int i = 0; i < pathLengths.size(); i++)
+                {
+                    if (pathLengths[i] < 0)
+                        continue;
+                    successes++;
+                    // The grid runs finest first, so the first run to take a route is its reference
+                    referenceLengths[i].insert({ routes[i], pathLengths[i] });
+                }
+                tuningResult result;
+                result.robotSpeed = robotSpeed;
+                result.raySpeed = raySpeed;
+                result.angleStep = angleStep;
+                result.successRate = (float)successes / pathLengths.size();
+                result.senseMicrosPerStep = senseMicros[timingRuns / 2];
+                results.push_back(result);
+                runLengths.push_back(pathLengths);
+                runRoutes.push_back(routes);
+            }
+        }
+    }
+
+    for (int i = 0; i < results.size(); i++)
+    {
+        float deviation = 0;
+        int successes = 0;
+        for (int j = 0; j < runLengths[i].size(); j++)
+        {
+            if (runLengths[i][j] < 0)
+                continue;
+            deviation += abs(runLengths[i][j] / referenceLengths[j][runRoutes[i][j]] - 1);
+            successes++;
+        }
+        results[i].pathDeviation = successes ? deviation / successes : 999999999;
+    }
+
+    vector<tuningResult> pareto;
+    for (auto& a : results)
     {
-        if (raycast(origin, vec2(cos(angle), sin(angle)), r, obstacleList, hitPoint))
+        if (a.successRate == 0)
+            continue;
+        bool dominated = false;
+        for (auto& b : results)
         {
-            if(!hittingObstacle)
-                hitPoints.push_back(lastHitPoint);
-            hittingObstacle = true;
-            lastHitPoint = hitPoint;
+            bool noWorse = b.successRate >= a.successRate && b.pathDeviation <= a.pathDeviation && b.senseMicrosPerStep <= a.senseMicrosPerStep;
+            bool better = b.successRate > a.successRate || b.pathDeviation < a.pathDeviation || b.senseMicrosPerStep < a.senseMicrosPerStep;
+            if (noWorse && better)
+            {
+                dominated = true;
+                break;
+            }
         }
-        else if (hittingObstacle)
+        if (!dominated)
+            pareto.push_back(a);
+    }
+    return pareto;
+}
+
+int RunTuning(const string& filepath)
+{
+    ofstream stream(filepath);
+    if (!stream)
+    {
+        cout << "Could not open " << filepath << endl;
+        return -1;
+    }
+
+    stream << "# profile robotSpeed raySpeed angleStep successRate pathDeviation senseMicrosPerStep" << endl;
+    for (auto& profile : CreateWorldProfiles())
+    {
+        cout << "Tuning " << profile.name << endl;
+        vector<tuningResult> pareto = TuneProfile(profile);
+        float bestSuccessRate = 0;
+        for (auto& result : pareto)
+            bestSuccessRate = max(bestSuccessRate, result.successRate);
+        if (bestSuccessRate < 1)
+            cout << "Warning: no setting solves every " << profile.name << " scenario, best success rate is " << bestSuccessRate << endl;
+
+        for (auto& result : pareto)
         {
-            hitPoints.push_back(hitPoint);
-            hittingObstacle = false;
+            stream << profile.name << ' ' << result.robotSpeed << ' ' << result.raySpeed << ' ' << result.angleStep << ' '
+                << result.successRate << ' ' << result.pathDeviation << ' ' << result.senseMicrosPerStep << endl;
+            cout << "  robotSpeed " << result.robotSpeed << " raySpeed " << result.raySpeed << " angleStep " << result.angleStep
+                << " -> success " << result.successRate << " deviation " << result.pathDeviation
+                << " sense " << result.senseMicrosPerStep << "us/step" << endl;
         }
     }
+    return 0;
+}
+
+// Picks the cheapest Pareto setting among the ones with the best success rate
+bool LoadTuning(const string& filepath, const string& profileName)
+{
+    ifstream stream(filepath);
+    string line;
+    bool found = false;
+    tuningResult best{};
+    while (getline(stream, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        stringstream ss(line);
+        string name;
+        tuningResult result;
+        ss >> name >> result.robotSpeed >> result.raySpeed >> result.angleStep
+            >> result.successRate >> result.pathDeviation >> result.senseMicrosPerStep;
+        if (!ss || name != profileName)
+            continue;
+
+        if (!found || result.successRate > best.successRate ||
+            (result.successRate == best.successRate && result.senseMicrosPerStep < best.senseMicrosPerStep))
+            best = result;
+        found = true;
+    }
+    if (!found)
+        return false;
+
+    robotSpeed = best.robotSpeed;
+    raySpeed = best.raySpeed;
+    angleStep = best.angleStep;
+    return true;
 }
 
 void moveRobot(vec2 direction, float speed, vec2 *robotVertices, int robotVertexAmount)
@@ -383,10 +1326,33 @@ void moveRobot(vec2 direction, float speed, vec2 *robotVertices, int robotVertex
 
 }
 
-int main(void)
+int main(int argc, char** argv)
 {
     cv::utils::logging::setLogLevel(cv::utils::logging::LogLevel::LOG_LEVEL_SILENT);
 
+    const string tuningFile = "TangentBug.tuning";
+    if (argc > 1 && string(argv[1]) == "--tune")
+        return RunTuning(tuningFile);
+
+    string profileName = argc > 1 ? argv[1] : "circles";
+    worldProfile profile;
+    for (auto& currProfile : CreateWorldProfiles())
+    {
+        if (currProfile.name == profileName)
+            profile = currProfile;
+    }
+    if (profile.name.empty())
+    {
+        cout << "Unknown world profile " << profileName << endl;
+        return -1;
+    }
+    obstacleList = profile.obstacles;
+    resetRobot(profile.scenarios[0].start, profile.scenarios[0].goal);
+
+    if (LoadTuning(tuningFile, profileName))
+        cout << "Loaded tuning for " << profileName << ": robotSpeed " << robotSpeed
+            << " raySpeed " << raySpeed << " angleStep " << angleStep << endl;
+
     GLFWwindow* window;
 
     /* Initialize the library */
@@ -407,6 +1373,9 @@ int main(void)
 
     glfwSwapInterval(1);
 
+    glfwSetScrollCallback(window, scrollCallback);
+    glfwSetKeyCallback(window, keyCallback);
+
     if (glewInit() != GLEW_OK)
         cout << "Error!" << endl;
 
@@ -438,22 +1407,18 @@ int main(void)
     vec2* goalPositions = new vec2[PointsPerCircle + 1];
     CreateCircleVertices(goalCenter, goalRadius, goalPositions);
 
-    obstacleList.push_back(new circle(
-        vec2(0, 0.5), .3
-    ));
-
-    obstacleList.push_back(new circle(
-        vec2(0, -0.5), .3
-    ));
-
-    //obstacleList.push_back(triangle(
-    //    vec2(1, -1),
-    //    vec2(0.3, -0.4),
-    //    vec2(1, 0)));
-
-
     obstacleWorld world(obstacleList);
 
+    // Open on the whole scene: obstacles, robot and goal
+    vec2 frameMin = vec2(min(robotCenter.x, goalCenter.x), min(robotCenter.y, goalCenter.y)) - vec2(robotVisionRadius, robotVisionRadius);
+    vec2 frameMax = vec2(max(robotCenter.x, goalCenter.x), max(robotCenter.y, goalCenter.y)) + vec2(robotVisionRadius, robotVisionRadius);
+    if (!world.chunks.empty())
+    {
+        frameMin = vec2(min(frameMin.x, world.boundsMin.x), min(frameMin.y, world.boundsMin.y));
+        frameMax = vec2(max(frameMax.x, world.boundsMax.x), max(frameMax.y, world.boundsMax.y));
+    }
+    sceneCamera.frame(frameMin, frameMax);
+
     unsigned int screenBuffer;
     unsigned int robotBuffer;
     unsigned int goalBuffer;
@@ -538,18 +1503,15 @@ int main(void)
     int inputColLocation = glGetUniformLocation(shader, "inputCol");
     if (inputColLocation == -1) return -1;
 
-    vec2 newCenter;
-    vec2 translation;
+    int viewLocation = glGetUniformLocation(shader, "view");
+    if (viewLocation == -1) return -1;
 
-    vec2 goalDirection = normalize(goalCenter - robotCenter);
+    float view[9];
+    vector<GLsizei> chunkCounts;
+    vector<const void*> chunkOffsets;
 
-    float distToGoal = (goalCenter - robotCenter).norm();
-    float lastDistToGoal = 999999999;
-    float dreach = 999999999;
-    float dfollowed = 999999999;
-    vec2 lastDirection;
-    vec2 pointToFollow;
-    vec2 followingBoundaryStartingPos;
+    vec2 lastRobotCenter;
+    vec2 lastMovingTowards;
 
     cv::Mat M;
     M.create(height, width, CV_8UC3);
@@ -574,6 +1536,7 @@ int main(void)
         glClear(GL_COLOR_BUFFER_BIT);
 
         //Draw world
+        glUniformMatrix3fv(viewLocation, 1, GL_FALSE, identityView);
         glUniform3f(inputColLocation, 0, 0, 1);
         glBindBuffer(GL_ARRAY_BUFFER, screenBuffer);
         glEnableVertexAttribArray(0);
@@ -581,6 +1544,9 @@ int main(void)
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, screenIbo);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
 
+        sceneCamera.viewMatrix(view);
+        glUniformMatrix3fv(viewLocation, 1, GL_FALSE, view);
+
         //Draw vision
         glUniform3f(inputColLocation, 1, 1, 0);
         glBindBuffer(GL_ARRAY_BUFFER, robotVisionBuffer);
@@ -596,7 +1562,9 @@ int main(void)
         glEnableVertexAttribArray(0);
         glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 2, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, obstacleIbo);
-        glDrawElements(GL_TRIANGLES, world.indicesSize, GL_UNSIGNED_INT, nullptr);
+        world.visibleChunks(sceneCamera.viewMin(), sceneCamera.viewMax(), chunkCounts, chunkOffsets);
+        if (!chunkCounts.empty())
+            glMultiDrawElements(GL_TRIANGLES, chunkCounts.data(), GL_UNSIGNED_INT, chunkOffsets.data(), chunkCounts.size());
 
         //Draw goal
         glUniform3f(inputColLocation, 0, 1, 0);
@@ -625,70 +1593,16 @@ int main(void)
         glDrawElements(GL_TRIANGLES, circleIndicesSize, GL_UNSIGNED_INT, nullptr);
 
         //Update robot
-        lastDistToGoal = distToGoal;
-        if (distToGoal <= robotSpeed)
-        {
-            translation = goalCenter - robotCenter;
-            robotCenter = goalCenter;
-            Translate(robotPositions, (PointsPerCircle + 1), translation);
-            Translate(robotVisionPositions, (PointsPerCircle + 1), translation);
-            done = true;
-        }
-        else
-        {
-            vec2 raycastHit;
-            if (!followingBorder && !raycast(robotCenter, goalDirection, robotVisionRadius, obstacleList, raycastHit))
-            {
-                vec2 movingTowardsTranslation = robotCenter + goalDirection * robotVisionRadius - movingTowards;
-                movingTowards = robotCenter + goalDirection * robotVisionRadius;
-                translation = goalDirection * robotSpeed;
-                robotCenter += translation;
-                Translate(robotPositions, (PointsPerCircle + 1), translation);
-                Translate(robotVisionPositions, (PointsPerCircle + 1), translation);
-                Translate(movingTowardsPositions, (PointsPerCircle + 1), movingTowardsTranslation);
-            }
-            else
-            {
-                vector<vec2> pointsToFollow;
-                circleCast(robotCenter, robotVisionRadius, obstacleList, pointsToFollow);
-                float minDist = 9999999999;
-                for (auto& point : pointsToFollow)
-                {
-                    if (followingBorder && dot(normalize(point - robotCenter), lastDirection) < -.01)
-                        continue;
+        lastRobotCenter = robotCenter;
+        lastMovingTowards = movingTowards;
+        done = stepRobot(obstacleList);
+        Translate(robotPositions, (PointsPerCircle + 1), robotCenter - lastRobotCenter);
+        Translate(robotVisionPositions, (PointsPerCircle + 1), robotCenter - lastRobotCenter);
+        Translate(movingTowardsPositions, (PointsPerCircle + 1), movingTowards - lastMovingTowards);
 
-                    float distToPoint = (point - robotCenter).norm();
-                    float distPointToGoal = (goalCenter - point).norm();
-                    if (distPointToGoal + distToPoint < minDist)
-                    {
-                        pointToFollow = point;
-                        minDist = distToGoal + distToPoint;
-                        dreach = distPointToGoal;
-                    }
-                }
-                vec2 movingTowardsTranslation = pointToFollow - movingTowards;
-                movingTowards = pointToFollow;
-                Translate(movingTowardsPositions, (PointsPerCircle + 1), movingTowardsTranslation);
-                translation = normalize(pointToFollow - robotCenter) * robotSpeed;
-                robotCenter += translation;
-                Translate(robotPositions, (PointsPerCircle + 1), translation);
-                Translate(robotVisionPositions, (PointsPerCircle + 1), translation);
-                goalDirection = normalize(goalCenter - robotCenter);
-            }
-        }
-        distToGoal = (goalCenter - robotCenter).norm();
-        lastDirection = normalize(pointToFollow - robotCenter);
-        if (!followingBorder && distToGoal > lastDistToGoal)
-        {
-            dfollowed = (goalCenter - pointToFollow).norm();
-            followingBorder = true;
-            followingBoundaryStartingPos = robotCenter;
-        }
+        // After the robot moves so following doesn't trail it by a step
+        updateCamera(window);
 
-        if (followingBorder && dreach < dfollowed)
-        {
-            followingBorder = false;
-        }
         //glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
         //glReadBuffer(GL_COLOR_ATTACHMENT0);
         //glReadPixels(0, 0, width, height, GL_BGR, GL_UNSIGNED_BYTE, M.data);